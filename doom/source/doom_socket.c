@@ -202,7 +202,7 @@ int doom_socket_recv_key(int* pressed, unsigned char* key) {
     /* Check message type */
     if (msg_type == MSG_SHUTDOWN) {
         printf("Received SHUTDOWN message from Python\n");
-        return -1;
+        return DOOM_SOCKET_SHUTDOWN;
     }
 
     if (msg_type != MSG_KEY_EVENT) {
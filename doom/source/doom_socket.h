@@ -22,6 +22,9 @@
 #define MSG_SHUTDOWN      0x04  /* Bidirectional: Clean shutdown */
 #define MSG_SCREENSHOT    0x05  /* DOOM → Python: SDL screenshot saved, request combine */
 
+/* doom_socket_recv_key() result for a clean shutdown (distinct from -1 error) */
+#define DOOM_SOCKET_SHUTDOWN -2
+
 /* Socket path (must match Python side) */
 #define SOCKET_PATH "/tmp/kicad_doom.sock"
 
@@ -53,7 +56,8 @@ int doom_socket_send_frame(const char* json_data, size_t len);
  *   pressed: Output - 1 if key pressed, 0 if released
  *   key: Output - Key code (DOOM key code format)
  *
- * Returns: 1 if key event received, 0 if no data, -1 on error
+ * Returns: 1 if key event received, 0 if no data, -1 on error,
+ *          DOOM_SOCKET_SHUTDOWN if Python sent a clean MSG_SHUTDOWN
  */
 int doom_socket_recv_key(int* pressed, unsigned char* key);
 
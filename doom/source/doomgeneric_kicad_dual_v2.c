@@ -410,7 +410,19 @@ uint32_t DG_GetTicksMs()
 int DG_GetKey(int* pressed, unsigned char* doomKey)
 {
   if (s_KeyQueueReadIndex == s_KeyQueueWriteIndex){
-    return 0;
+    /* SDL queue empty - check for scripted input from the Python side
+     * (MSG_KEY_EVENT carries DOOM key codes, no SDL conversion needed) */
+    int ret = doom_socket_recv_key(pressed, doomKey);
+    if (ret == DOOM_SOCKET_SHUTDOWN) {
+        /* Renderer finished cleanly (e.g. end of a load test run).
+         * Don't echo SHUTDOWN back - the peer has already closed. */
+        exit(0);
+    }
+    if (ret < 0) {
+        fprintf(stderr, "ERROR: Socket closed while reading key events\n");
+        exit(1);
+    }
+    return ret;
   }else{
     unsigned short keyData = s_KeyQueue[s_KeyQueueReadIndex];
     s_KeyQueueReadIndex++;
@@ -0,0 +1,374 @@
+#!/usr/bin/env python3
+"""
+ScopeDoom - Scripted Input Load Generator
+
+Drives DOOM through scripted or randomized input by sending MSG_KEY_EVENT
+messages over the renderer socket, while recording frame rate, payload
+sizes, vector-to-point conversion time, memory growth and audio underruns.
+Use it for long soak runs instead of playing in the SDL window.
+
+Usage:
+    1. Run this script: python3 doom_load.py --scenario mix --duration 7200
+    2. In another terminal: ./run_doom.sh dual -w 1 1
+    3. Stats are printed every interval and written to --log (CSV)
+
+Scenarios:
+    walk    - Walk forward, turn, repeat (corridor loops)
+    spin    - Rapid left/right turning (maximum wall churn per frame)
+    fire    - Strafe and fire continuously (monster rooms, sprite load)
+    random  - Random keys with random hold times (seeded, repeatable)
+    mix     - Cycle through all of the above
+"""
+
+import argparse
+import csv
+import itertools
+import json
+import os
+import random
+import subprocess
+import threading
+import time
+
+from doom_scope import DoomScope, MSG_KEY_EVENT
+
+# DOOM key codes (from doomgeneric's doomkeys.h)
+DOOM_KEYS = {
+    'right': 0xae,
+    'left': 0xac,
+    'up': 0xad,
+    'down': 0xaf,
+    'strafe_left': 0xa0,
+    'strafe_right': 0xa1,
+    'use': 0xa2,
+    'fire': 0xa3,
+    'run': 0x80 + 0x36,  # KEY_RSHIFT
+    'escape': 27,
+    'enter': 13,
+}
+
+# Menu path from the title screen: Menu -> New Game -> Episode -> Skill
+MENU_START = [('escape', 0.1, 0.5), ('enter', 0.1, 0.5),
+              ('enter', 0.1, 0.5), ('enter', 0.1, 1.0)]
+
+# Stats configuration
+REPORT_INTERVAL = 10.0  # Seconds between stats rows
+
+
+def scenario_walk(rng):
+    """Walk forward, then turn - loops around most rooms."""
+    while True:
+        yield ('up', rng.uniform(1.0, 3.0), 0.05)
+        yield (rng.choice(['left', 'right']), rng.uniform(0.3, 0.8), 0.05)
+
+
+def scenario_spin(rng):
+    """Rapid turning - every frame sees a new set of walls."""
+    while True:
+        yield (rng.choice(['left', 'right']), rng.uniform(0.05, 0.2), 0.02)
+
+
+def scenario_fire(rng):
+    """Strafe back and forth while firing."""
+    while True:
+        yield ('fire', 0.5, 0.0)
+        yield (rng.choice(['strafe_left', 'strafe_right']), rng.uniform(0.2, 0.6), 0.0)
+        yield (rng.choice(['left', 'right']), 0.15, 0.1)
+
+
+def scenario_random(rng):
+    """Any movement key, random hold and pause."""
+    keys = ['up', 'down', 'left', 'right', 'strafe_left', 'strafe_right', 'fire', 'use']
+    while True:
+        yield (rng.choice(keys), rng.uniform(0.02, 1.5), rng.uniform(0.0, 0.3))
+
+
+def scenario_mix(rng):
+    """
+    Cycle through the other scenarios, 30 seconds each.
+
+    Time is counted from each step's hold + pause rather than the clock, so
+    the same seed always gives the same sequence.
+    """
+    while True:
+        for make in (scenario_walk, scenario_spin, scenario_fire, scenario_random):
+            scripted = 0.0
+            for step in make(rng):
+                yield step
+                scripted += step[1] + step[2]
+                if scripted >= 30.0:
+                    break
+
+
+def scenario_file(path):
+    """
+    Load a JSON script to replay forever.
+
+    Format: [{"key": "up", "hold": 1.5, "pause": 0.1}, ...]
+    """
+    with open(path) as f:
+        steps = json.load(f)
+    for step in steps:
+        if step['key'] not in DOOM_KEYS:
+            raise ValueError(f"Unknown key in script: {step['key']}")
+
+    def replay():
+        while True:
+            for step in steps:
+                yield (step['key'], step.get('hold', 0.1), step.get('pause', 0.0))
+    return replay()
+
+
+SCENARIOS = {
+    'walk': scenario_walk,
+    'spin': scenario_spin,
+    'fire': scenario_fire,
+    'random': scenario_random,
+    'mix': scenario_mix,
+}
+
+
+def get_pid_rss_mb(pid):
+    """Current RSS of a process in MB, via ps (works on macOS and Linux)."""
+    try:
+        out = subprocess.run(['ps', '-o', 'rss=', '-p', str(pid)],
+                             capture_output=True, text=True, timeout=2.0).stdout
+        return int(out.strip()) / 1024
+    except (ValueError, OSError, subprocess.SubprocessError):
+        return None
+
+
+class LoadScope(DoomScope):
+    """DoomScope renderer that also sends scripted input and records stats."""
+
+    def __init__(self, steps, audio=True, doom_pid=None, log_path=None):
+        super().__init__()
+        self.steps = steps
+        self.audio = audio
+        self.doom_pid = doom_pid
+        self.log_path = log_path
+        self.print_fps = False  # report() covers it, once per interval
+
+        # Interval stats (reset every report)
+        self.stats_lock = threading.Lock()
+        self.interval_frames = 0
+        self.payload_sizes = []
+        self.convert_times = []
+        self.point_counts = []
+
+        # Totals
+        self.total_frames = 0
+        self.keys_sent = 0
+        self.held_keys = set()
+        self.input_stop = threading.Event()
+
+    def frame_to_points(self, frame):
+        """Time the conversion and record payload size alongside it."""
+        start = time.perf_counter()
+        points = super().frame_to_points(frame)
+        elapsed_ms = (time.perf_counter() - start) * 1000
+
+        with self.stats_lock:
+            self.interval_frames += 1
+            self.total_frames += 1
+            self.payload_sizes.append(self.last_payload_len)
+            self.convert_times.append(elapsed_ms)
+            self.point_counts.append(len(points))
+        return points
+
+    def start_audio(self):
+        """Skip the sound card entirely in headless runs."""
+        if self.audio:
+            super().start_audio()
+        else:
+            print("[OK] Audio disabled (headless)")
+
+    def send_key(self, name, pressed):
+        """Send one MSG_KEY_EVENT to DOOM."""
+        self._send_message(MSG_KEY_EVENT, {'pressed': pressed, 'key': DOOM_KEYS[name]})
+        self.keys_sent += 1
+        if pressed:
+            self.held_keys.add(name)
+        else:
+            self.held_keys.discard(name)
+
+    def input_loop(self, menu_start):
+        """Background thread to play the input script."""
+        print("[OK] Input loop started")
+        intro = MENU_START if menu_start else []
+        try:
+            for name, hold, pause in itertools.chain(intro, self.steps):
+                if self.input_stop.is_set():
+                    break
+                self.send_key(name, True)
+                if self.input_stop.wait(hold):
+                    break
+                self.send_key(name, False)
+                self.input_stop.wait(pause)
+        finally:
+            # Never leave DOOM with a key stuck down
+            for name in list(self.held_keys):
+                self.send_key(name, False)
+        print("Input loop exiting")
+
+    def report(self, writer, elapsed, interval, rss_start):
+        """Print and log one row of interval stats."""
+        with self.stats_lock:
+            frames = self.interval_frames
+            payloads = self.payload_sizes
+            converts = sorted(self.convert_times)
+            points = self.point_counts
+            self.interval_frames = 0
+            self.payload_sizes = []
+            self.convert_times = []
+            self.point_counts = []
+
+        fps = frames / interval if interval > 0 else 0
+        payload_avg = sum(payloads) / len(payloads) if payloads else 0
+        payload_max = max(payloads) if payloads else 0
+        convert_avg = sum(converts) / len(converts) if converts else 0
+        convert_p95 = converts[int(len(converts) * 0.95)] if converts else 0
+        points_avg = sum(points) / len(points) if points else 0
+        rss = get_pid_rss_mb(os.getpid()) or 0
+        doom_rss = get_pid_rss_mb(self.doom_pid) if self.doom_pid else None
+
+        row = {
+            'elapsed_s': round(elapsed, 1),
+            'fps': round(fps, 2),
+            'frames': self.total_frames,
+            'payload_avg_bytes': int(payload_avg),
+            'payload_max_bytes': payload_max,
+            'convert_avg_ms': round(convert_avg, 3),
+            'convert_p95_ms': round(convert_p95, 3),
+            'points_avg': int(points_avg),
+            'rss_mb': round(rss, 1),
+            'rss_growth_mb': round(rss - rss_start, 1),
+            'doom_rss_mb': round(doom_rss, 1) if doom_rss is not None else '',
+            'underruns': self.display.underruns,
+            'keys_sent': self.keys_sent,
+        }
+        if writer:
+            writer.writerow(row)
+
+        doom_str = f" | DOOM RSS: {row['doom_rss_mb']}MB" if doom_rss is not None else ""
+        print(f"[{elapsed:7.0f}s] FPS: {fps:.1f} | Payload: {payload_avg / 1024:.1f}KB avg, "
+              f"{payload_max / 1024:.1f}KB max | Convert: {convert_avg:.2f}ms avg, "
+              f"{convert_p95:.2f}ms p95 | Points: {int(points_avg)} | "
+              f"RSS: {rss:.1f}MB (+{rss - rss_start:.1f}){doom_str} | "
+              f"Underruns: {self.display.underruns} | Keys: {self.keys_sent}")
+        return row
+
+    def run_load(self, duration, interval, menu_start):
+        """Main run loop for a load test."""
+        print("=" * 60)
+        print("ScopeDoom - Load Generator")
+        print("=" * 60)
+        print()
+        print("Then run DOOM:")
+        print("  ./run_doom.sh dual -w 1 1")
+        print()
+        print("=" * 60)
+
+        log_file = None
+        writer = None
+        input_thread = None
+        receive_thread = None
+        start = None
+        try:
+            self.start_audio()
+            self.display.start()
+            self.create_socket()
+            self.accept_connection()
+
+            self.running = True
+            receive_thread = threading.Thread(target=self.receive_loop, daemon=True)
+            receive_thread.start()
+            input_thread = threading.Thread(target=self.input_loop, args=(menu_start,), daemon=True)
+            input_thread.start()
+
+            if self.log_path:
+                log_file = open(self.log_path, 'w', newline='')
+                writer = csv.DictWriter(log_file, fieldnames=[
+                    'elapsed_s', 'fps', 'frames', 'payload_avg_bytes', 'payload_max_bytes',
+                    'convert_avg_ms', 'convert_p95_ms', 'points_avg', 'rss_mb',
+                    'rss_growth_mb', 'doom_rss_mb', 'underruns', 'keys_sent'])
+                writer.writeheader()
+
+            print(f"\n[OK] Running for {duration:.0f}s! Press Ctrl+C to stop\n")
+
+            rss_start = get_pid_rss_mb(os.getpid()) or 0
+            start = time.time()
+            last_report = start
+            while self.running and receive_thread.is_alive():
+                now = time.time()
+                if now - start >= duration:
+                    break
+                if now - last_report >= interval:
+                    self.report(writer, now - start, now - last_report, rss_start)
+                    if log_file:
+                        log_file.flush()
+                    last_report = now
+                time.sleep(0.1)
+
+        except KeyboardInterrupt:
+            print("\n\nStopping...")
+        except Exception as e:
+            print(f"Error: {e}")
+            import traceback
+            traceback.print_exc()
+        finally:
+            # Check before stopping - the receive loop exits once running is cleared
+            doom_gone = receive_thread is not None and not receive_thread.is_alive()
+            self.running = False
+            self.input_stop.set()
+            if input_thread:
+                input_thread.join(timeout=1.0)  # Let it release held keys
+
+            # Final row and summary, also when stopped with Ctrl+C
+            if start is not None:
+                now = time.time()
+                self.report(writer, now - start, now - last_report, rss_start)
+
+                if doom_gone:
+                    print("DOOM disconnected before the run finished")
+
+                print()
+                print("=" * 60)
+                print(f"Duration: {now - start:.0f}s | Frames: {self.total_frames} | "
+                      f"Avg FPS: {self.total_frames / max(now - start, 1e-6):.1f}")
+                print(f"RSS growth: {(get_pid_rss_mb(os.getpid()) or 0) - rss_start:.1f}MB | "
+                      f"Underruns: {self.display.underruns} | Keys sent: {self.keys_sent}")
+                print("=" * 60)
+
+            if log_file:
+                log_file.close()
+            self.cleanup()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Scripted input load generator for ScopeDoom")
+    parser.add_argument('--scenario', choices=sorted(SCENARIOS), default='mix',
+                        help="Built-in input scenario (default: mix)")
+    parser.add_argument('--script', help="JSON input script to loop instead of a scenario")
+    parser.add_argument('--seed', type=int, default=0, help="Random seed for repeatable runs")
+    parser.add_argument('--duration', type=float, default=3600.0, help="Run time in seconds")
+    parser.add_argument('--interval', type=float, default=REPORT_INTERVAL,
+                        help="Seconds between stats rows")
+    parser.add_argument('--log', help="Write interval stats to this CSV file")
+    parser.add_argument('--no-audio', action='store_true', help="Don't open the sound card")
+    parser.add_argument('--doom-pid', type=int, help="Also sample RSS of the DOOM process")
+    parser.add_argument('--menu-start', action='store_true',
+                        help="Start a new game through the menu (when DOOM runs without -w)")
+    args = parser.parse_args()
+
+    if args.script:
+        steps = scenario_file(args.script)
+    else:
+        steps = SCENARIOS[args.scenario](random.Random(args.seed))
+
+    scope = LoadScope(steps, audio=not args.no_audio, doom_pid=args.doom_pid, log_path=args.log)
+    scope.run_load(args.duration, args.interval, args.menu_start)
+
+
+if __name__ == '__main__':
+    main()
@@ -9,6 +9,10 @@ Usage:
     1. Run this script: python3 doom_scope.py
     2. In another terminal: ./run_doom.sh dual -w 1 1
     3. Connect sound card L/R to scope X/Y inputs
+
+The scope output is a DisplayServer (scope_server.py): DOOM is composited
+as the top-priority layer, and other clients (test patterns, clock...)
+can add their own layers over /tmp/scope_display.sock.
 """
 
 import socket
@@ -17,15 +21,10 @@ import json
 import threading
 import numpy as np
 import time
-import sys
 import os
 
-try:
-    import sounddevice as sd
-except ImportError:
-    print("ERROR: sounddevice not installed!")
-    print("Install with: pip install sounddevice numpy")
-    sys.exit(1)
+from scope_server import (DisplayServer, line_to_points, send_message, recv_exact,
+                          SAMPLES_PER_LINE, BLANK_SAMPLES, DOOM_PRIORITY)
 
 # Socket configuration
 SOCKET_PATH = "/tmp/kicad_doom.sock"
@@ -37,17 +36,17 @@ MSG_INIT_COMPLETE = 0x03
 MSG_SHUTDOWN = 0x04
 
 # Audio configuration
-SAMPLE_RATE = 44100  # Standard rate - most stable
 AMPLITUDE = 1.0  # Full scale
 
+# Display server layer for DOOM (other clients share what's left)
+DOOM_LAYER = 'doom'
+DOOM_SHARE = 0.8  # Fraction of each cycle's sample budget DOOM gets first
+                  # (socket clients are capped below DOOM_PRIORITY, see scope_server.py)
+
 # DOOM screen dimensions
 DOOM_WIDTH = 320
 DOOM_HEIGHT = 200
 
-# Rendering config
-SAMPLES_PER_LINE = 30  # Samples per wall edge (more = brighter but slower)
-BLANK_SAMPLES = 3       # Samples to move between disconnected lines (retrace)
-
 
 class DoomScope:
     """Renders DOOM on oscilloscope via sound card."""
@@ -61,15 +60,14 @@ class DoomScope:
         self.current_frame = None
         self.frame_lock = threading.Lock()
 
-        # Audio output
-        self.audio_points = []
-        self.audio_lock = threading.Lock()
-        self.stream = None
-        self.audio_index = 0
+        # Scope output (composites DOOM with other display clients)
+        self.display = DisplayServer()
 
         # Stats
         self.frame_count = 0
         self.last_frame_time = time.time()
+        self.last_payload_len = 0  # Size of the most recent message payload (bytes)
+        self.print_fps = True      # Per-second FPS line in receive_loop
 
     def doom_to_scope(self, doom_x, doom_y):
         """
@@ -91,16 +89,6 @@ class DoomScope:
 
         return x * AMPLITUDE, y * AMPLITUDE
 
-    def line_to_points(self, x1, y1, x2, y2, num_samples):
-        """Generate points along a line."""
-        points = []
-        for i in range(num_samples):
-            t = i / max(1, num_samples - 1)
-            x = x1 + (x2 - x1) * t
-            y = y1 + (y2 - y1) * t
-            points.append((x, y))
-        return points
-
     def frame_to_points(self, frame):
         """Convert a DOOM frame to oscilloscope points."""
         points = []
@@ -150,10 +138,10 @@ class DoomScope:
                 for ex1, ey1, ex2, ey2 in edges:
                     # Blank move to start of line
                     if points:
-                        points.extend(self.line_to_points(last_x, last_y, ex1, ey1, BLANK_SAMPLES))
+                        points.extend(line_to_points(last_x, last_y, ex1, ey1, BLANK_SAMPLES))
 
                     # Draw the line
-                    points.extend(self.line_to_points(ex1, ey1, ex2, ey2, SAMPLES_PER_LINE))
+                    points.extend(line_to_points(ex1, ey1, ex2, ey2, SAMPLES_PER_LINE))
                     last_x, last_y = ex2, ey2
 
             elif obj_type == 'entity':
@@ -185,8 +173,8 @@ class DoomScope:
 
                 for ex1, ey1, ex2, ey2 in edges:
                     if points:
-                        points.extend(self.line_to_points(last_x, last_y, ex1, ey1, BLANK_SAMPLES))
-                    points.extend(self.line_to_points(ex1, ey1, ex2, ey2, SAMPLES_PER_LINE // 2))
+                        points.extend(line_to_points(last_x, last_y, ex1, ey1, BLANK_SAMPLES))
+                    points.extend(line_to_points(ex1, ey1, ex2, ey2, SAMPLES_PER_LINE // 2))
                     last_x, last_y = ex2, ey2
 
         # If no points, draw a small dot at center
@@ -195,50 +183,25 @@ class DoomScope:
 
         return points
 
-    def audio_callback(self, outdata, frames, time_info, status):
-        """Called by sounddevice to fill audio buffer."""
-        if status:
-            print(f"Audio status: {status}")
-
-        with self.audio_lock:
-            points = self.audio_points
-
-        if not points:
-            outdata.fill(0)
-            return
-
-        for i in range(frames):
-            idx = (self.audio_index + i) % len(points)
-            x, y = points[idx]
-            outdata[i, 0] = x  # Left = X
-            outdata[i, 1] = y  # Right = Y
-
-        self.audio_index = (self.audio_index + frames) % len(points)
+    def set_doom_points(self, points):
+        """Hand DOOM's latest points to the display server."""
+        self.display.set_layer(DOOM_LAYER, points, priority=DOOM_PRIORITY,
+                               share=DOOM_SHARE, name=DOOM_LAYER)
 
     def start_audio(self):
         """Start audio output stream."""
         # Start with a simple square while waiting for DOOM
-        self.audio_points = []
+        square = []
         size = 0.5
         for corner in [(-size, -size), (size, -size), (size, size), (-size, size), (-size, -size)]:
-            self.audio_points.extend([corner] * 200)
-
-        self.stream = sd.OutputStream(
-            samplerate=SAMPLE_RATE,
-            channels=2,
-            dtype='float32',
-            callback=self.audio_callback,
-            blocksize=2048
-        )
-        self.stream.start()
-        print("[OK] Audio stream started")
+            square.extend([corner] * 200)
+        self.set_doom_points(square)
+
+        self.display.start_audio()
 
     def stop_audio(self):
         """Stop audio output."""
-        if self.stream:
-            self.stream.stop()
-            self.stream.close()
-            self.stream = None
+        self.display.stop_audio()
 
     def create_socket(self):
         """Create and bind the Unix socket."""
@@ -265,22 +228,11 @@ class DoomScope:
 
     def _send_message(self, msg_type, payload):
         """Send a message to DOOM."""
-        payload_bytes = json.dumps(payload).encode('utf-8')
-        header = struct.pack('II', msg_type, len(payload_bytes))
-        try:
-            self.client_socket.sendall(header + payload_bytes)
-        except Exception as e:
-            print(f"Send error: {e}")
+        send_message(self.client_socket, msg_type, payload)
 
     def _recv_exact(self, n):
         """Receive exactly n bytes."""
-        data = b''
-        while len(data) < n:
-            chunk = self.client_socket.recv(n - len(data))
-            if not chunk:
-                return None
-            data += chunk
-        return data
+        return recv_exact(self.client_socket, n)
 
     def _receive_message(self):
         """Receive a message from DOOM."""
@@ -307,6 +259,7 @@ class DoomScope:
         payload_bytes = self._recv_exact(payload_len)
         if not payload_bytes:
             return None, None
+        self.last_payload_len = payload_len
 
         try:
             payload = json.loads(payload_bytes.decode('utf-8'))
@@ -335,17 +288,17 @@ class DoomScope:
                     # Convert frame to scope points
                     points = self.frame_to_points(payload)
 
-                    # Update audio buffer
-                    with self.audio_lock:
-                        self.audio_points = points
+                    # Update DOOM's layer on the display server
+                    self.set_doom_points(points)
 
                     self.frame_count += 1
                     now = time.time()
                     if now - self.last_frame_time >= 1.0:
-                        fps = self.frame_count / (now - self.last_frame_time)
-                        walls = len(payload.get('walls', []))
-                        entities = len(payload.get('entities', []))
-                        print(f"FPS: {fps:.1f} | Walls: {walls} | Entities: {entities} | Points: {len(points)}")
+                        if self.print_fps:
+                            fps = self.frame_count / (now - self.last_frame_time)
+                            walls = len(payload.get('walls', []))
+                            entities = len(payload.get('entities', []))
+                            print(f"FPS: {fps:.1f} | Walls: {walls} | Entities: {entities} | Points: {len(points)}")
                         self.frame_count = 0
                         self.last_frame_time = now
 
@@ -379,6 +332,7 @@ class DoomScope:
 
         try:
             self.start_audio()
+            self.display.start()
             self.create_socket()
             self.accept_connection()
 
@@ -403,7 +357,7 @@ class DoomScope:
     def cleanup(self):
         """Clean up resources."""
         self.running = False
-        self.stop_audio()
+        self.display.stop()
 
         if self.client_socket:
             try:
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""
+ScopeDoom - Clock Overlay
+
+Draws an analog clock in the corner of the scope as a display server client.
+Runs alongside DOOM (doom_scope.py) or the standalone scope_server.py.
+
+Usage:
+    python3 scope_clock.py
+"""
+
+import math
+import time
+
+from scope_server import DisplayClient
+
+# Clock configuration
+CENTER_X = 0.8        # Top-right corner, clear of most DOOM walls
+CENTER_Y = 0.8
+RADIUS = 0.15
+FACE_SEGMENTS = 24    # Lines used to approximate the face circle
+PRIORITY = 1          # Above test patterns, below DOOM
+SHARE = 0.1           # Fraction of the per-cycle sample budget
+
+
+def hand(angle, length):
+    """Line from the center at a clockwise angle from 12 o'clock."""
+    x = CENTER_X + math.sin(angle) * length
+    y = CENTER_Y + math.cos(angle) * length
+    return [CENTER_X, CENTER_Y, x, y]
+
+
+def clock_lines(now):
+    """Build the face and hands for a struct_time."""
+    lines = []
+
+    # Face
+    for i in range(FACE_SEGMENTS):
+        a1 = 2 * math.pi * i / FACE_SEGMENTS
+        a2 = 2 * math.pi * (i + 1) / FACE_SEGMENTS
+        lines.append([CENTER_X + math.sin(a1) * RADIUS, CENTER_Y + math.cos(a1) * RADIUS,
+                      CENTER_X + math.sin(a2) * RADIUS, CENTER_Y + math.cos(a2) * RADIUS])
+
+    # Hands (hour, minute, second)
+    hours = (now.tm_hour % 12) + now.tm_min / 60
+    minutes = now.tm_min + now.tm_sec / 60
+    lines.append(hand(2 * math.pi * hours / 12, RADIUS * 0.5))
+    lines.append(hand(2 * math.pi * minutes / 60, RADIUS * 0.8))
+    lines.append(hand(2 * math.pi * now.tm_sec / 60, RADIUS * 0.9))
+
+    return lines
+
+
+def main():
+    client = DisplayClient('clock', priority=PRIORITY, share=SHARE)
+    if not client.connect():
+        return
+
+    print("[OK] Clock connected to display server")
+    print("Press Ctrl+C to stop")
+
+    try:
+        while True:
+            if not client.submit(lines=clock_lines(time.localtime())):
+                print("Display server went away")
+                break
+            time.sleep(1.0 - time.time() % 1.0)  # Tick on the second
+    except KeyboardInterrupt:
+        print("\n\nStopping...")
+    finally:
+        client.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -7,6 +7,10 @@ Left channel = X axis, Right channel = Y axis (X-Y mode)
 
 Requirements:
     pip install sounddevice numpy
+
+Usage:
+    python3 scope_output.py            # Own the sound card directly
+    python3 scope_output.py --server   # Send the pattern to scope_server.py / doom_scope.py
 """
 
 import numpy as np
@@ -144,7 +148,35 @@ def list_audio_devices():
     print()
 
 
+def run_as_client(points):
+    """Submit the pattern as a low-priority layer on the display server."""
+    from scope_server import DisplayClient
+
+    client = DisplayClient('test-pattern', priority=0, share=0.1)
+    if not client.connect():
+        return
+
+    print("[OK] Connected to display server")
+    points = [(x * AMPLITUDE, y * AMPLITUDE) for x, y in points]
+
+    print("Press Ctrl+C to stop")
+    try:
+        # Resubmit periodically - it's how we notice the server going away
+        while client.submit(points=points):
+            time.sleep(1.0)
+        print("Display server went away")
+    except KeyboardInterrupt:
+        print("\n\nStopping...")
+    finally:
+        client.close()
+
+
 def main():
+    if '--server' in sys.argv:
+        scope = ScopeOutput()
+        run_as_client(scope.make_square(size=0.8, samples_per_edge=500))
+        return
+
     print("=" * 60)
     print("ScopeDoom - Oscilloscope Square Test")
     print("=" * 60)
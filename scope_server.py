@@ -0,0 +1,559 @@
+#!/usr/bin/env python3
+"""
+ScopeDoom - Vector Display Server
+
+Owns the sound card and composites display lists from several clients
+(DOOM, test patterns, HUD overlays, clock...) into one X-Y sample stream.
+Left channel = X, Right channel = Y (X-Y mode)
+
+Each client submits a display list over a Unix socket with a priority and
+a share of the per-cycle sample budget. Layers that need more than their
+share are decimated rather than slowing the refresh rate, and shares are
+granted in priority order, so a busy or slow low-priority client can't
+drag down the DOOM layer. Socket clients are capped below in-process
+layers (DOOM), so DOOM's share always comes first. Unused budget goes to
+higher-priority layers.
+
+Protocol: same framing as the DOOM socket
+Format: [4 bytes: msg_type][4 bytes: payload_len][N bytes: JSON payload]
+
+Display list payload (MSG_DISPLAY_LIST):
+    {"name": "clock", "priority": 1, "share": 0.1,
+     "lines": [[x1, y1, x2, y2], ...],     # Scope coords, -1.0 to 1.0
+     "points": [[x, y], ...]}              # Or raw samples (either/both)
+
+Usage:
+    python3 scope_server.py            # Standalone server (no DOOM)
+    python3 doom_scope.py              # Server embedded, DOOM as a layer
+"""
+
+import socket
+import struct
+import json
+import threading
+import math
+import time
+import sys
+import os
+
+try:
+    import sounddevice as sd
+except ImportError:
+    print("ERROR: sounddevice not installed!")
+    print("Install with: pip install sounddevice numpy")
+    sys.exit(1)
+
+# Socket configuration
+DISPLAY_SOCKET_PATH = "/tmp/scope_display.sock"
+
+# Message types (shared with DOOM socket where they overlap)
+MSG_INIT_COMPLETE = 0x03
+MSG_SHUTDOWN = 0x04
+MSG_DISPLAY_LIST = 0x06  # Client -> Server: Replace this client's display list
+
+# Audio configuration
+SAMPLE_RATE = 44100  # Standard rate - most stable
+AMPLITUDE = 1.0  # Full scale
+
+# Compositing config
+CYCLE_BUDGET = 11025    # Samples per composite cycle (4 Hz minimum refresh)
+SAMPLES_PER_LINE = 30   # Samples per line segment (more = brighter but slower)
+BLANK_SAMPLES = 3       # Samples to move between disconnected lines (retrace)
+COMPOSE_INTERVAL = 1 / 60  # Minimum seconds between recomposites
+DEFAULT_PRIORITY = 0
+DEFAULT_SHARE = 0.1
+DOOM_PRIORITY = 100        # In-process DOOM layer (doom_scope.py)
+MAX_CLIENT_PRIORITY = DOOM_PRIORITY - 1  # Socket clients always rank below DOOM
+CONNECT_TIMEOUT = 5.0      # Seconds a client waits for INIT_COMPLETE
+
+
+def send_message(sock, msg_type, payload):
+    """Send a framed JSON message."""
+    payload_bytes = json.dumps(payload).encode('utf-8')
+    header = struct.pack('II', msg_type, len(payload_bytes))
+    try:
+        sock.sendall(header + payload_bytes)
+    except Exception as e:
+        print(f"Send error: {e}")
+
+
+def recv_exact(sock, n):
+    """Receive exactly n bytes."""
+    data = b''
+    while len(data) < n:
+        chunk = sock.recv(n - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def line_to_points(x1, y1, x2, y2, num_samples):
+    """Generate points along a line."""
+    points = []
+    for i in range(num_samples):
+        t = i / max(1, num_samples - 1)
+        points.append((x1 + (x2 - x1) * t, y1 + (y2 - y1) * t))
+    return points
+
+
+def lines_to_points(lines):
+    """Convert [[x1, y1, x2, y2], ...] to a sample stream with blank moves."""
+    points = []
+    for x1, y1, x2, y2 in lines:
+        if points:
+            last_x, last_y = points[-1]
+            points.extend(line_to_points(last_x, last_y, x1, y1, BLANK_SAMPLES))
+        points.extend(line_to_points(x1, y1, x2, y2, SAMPLES_PER_LINE))
+    return points
+
+
+def decimate(points, count):
+    """Evenly pick count samples from points (keeps shape, dims it)."""
+    if count >= len(points):
+        return points
+    if count <= 0:
+        return []
+    step = len(points) / count
+    return [points[int(i * step)] for i in range(count)]
+
+
+def distance_sq(a, b):
+    return (a[0] - b[0]) ** 2 + (a[1] - b[1]) ** 2
+
+
+def clean_coords(values, count):
+    """
+    Return values as count floats clamped to -1..1, or None if it isn't
+    exactly count finite numbers.
+    """
+    if not isinstance(values, (list, tuple)) or len(values) != count:
+        return None
+    coords = []
+    for v in values:
+        if isinstance(v, bool) or not isinstance(v, (int, float)) or not math.isfinite(v):
+            return None
+        coords.append(max(-1.0, min(1.0, float(v))))
+    return coords
+
+
+def parse_display_list(payload):
+    """
+    Validate a client's display list payload.
+
+    Returns (name, points, priority, share). Bad points and lines are
+    dropped; priority is capped at MAX_CLIENT_PRIORITY and share clamped
+    to 0..1. Raises ValueError/TypeError if the payload is unusable.
+
+    Anything past one cycle's worth of samples is truncated before it is
+    expanded - it could never be played, and expanding it in the client
+    thread would hold the GIL away from DOOM's receive loop and the audio
+    callback.
+    """
+    if not isinstance(payload, dict):
+        raise ValueError("display list must be an object")
+
+    priority = min(int(payload.get('priority', DEFAULT_PRIORITY)), MAX_CLIENT_PRIORITY)
+    share = float(payload.get('share', DEFAULT_SHARE))
+    if not math.isfinite(share):
+        raise ValueError("share must be finite")
+    share = max(0.0, min(1.0, share))
+
+    raw_points = payload.get('points') or []
+    raw_lines = payload.get('lines') or []
+    if not isinstance(raw_points, list) or not isinstance(raw_lines, list):
+        raise ValueError("points and lines must be lists")
+
+    raw_points = raw_points[:CYCLE_BUDGET]
+    points = [tuple(p) for p in (clean_coords(p, 2) for p in raw_points) if p]
+
+    max_lines = (CYCLE_BUDGET - len(points)) // (SAMPLES_PER_LINE + BLANK_SAMPLES)
+    raw_lines = raw_lines[:max_lines]
+    lines = [line for line in (clean_coords(line, 4) for line in raw_lines) if line]
+    if lines:
+        points.extend(lines_to_points(lines))
+
+    return str(payload.get('name', '')), points, priority, share
+
+
+class Layer:
+    """One client's current display list."""
+
+    def __init__(self, name, points, priority, share):
+        self.name = name
+        self.points = points
+        self.priority = priority
+        self.share = share
+
+
+class DisplayServer:
+    """Composites client display lists onto the oscilloscope via sound card."""
+
+    def __init__(self, socket_path=DISPLAY_SOCKET_PATH, budget=CYCLE_BUDGET):
+        self.socket_path = socket_path
+        self.budget = budget
+        self.running = False
+        self.socket = None
+        self.clients = []
+
+        # Layers keyed by client id (in-process layers use their name)
+        self.layers = {}
+        self.layer_lock = threading.Lock()
+        self.dirty = threading.Event()
+
+        # Audio output
+        self.audio_points = []
+        self.audio_lock = threading.Lock()
+        self.stream = None
+        self.audio_index = 0
+
+        # Stats
+        self.underruns = 0
+        self.compose_count = 0
+        self.last_allocation = {}
+
+    def set_layer(self, layer_id, points, priority=DEFAULT_PRIORITY, share=DEFAULT_SHARE, name=None):
+        """Replace a layer's display list (called by client threads or in-process)."""
+        with self.layer_lock:
+            self.layers[layer_id] = Layer(name or str(layer_id), points, priority, share)
+        self.dirty.set()
+
+    def remove_layer(self, layer_id):
+        """Drop a layer (client disconnected)."""
+        with self.layer_lock:
+            self.layers.pop(layer_id, None)
+        self.dirty.set()
+
+    def allocate(self, layers):
+        """
+        Split the cycle budget between layers (sorted highest priority first).
+
+        Each layer gets up to its share, in priority order, so oversubscribed
+        shares come out of the low-priority layers. Spare budget then goes to
+        high-priority layers that are still short of samples. It never goes
+        to a layer below one that already fits: that would only lengthen the
+        cycle and slow the higher layer's refresh.
+        """
+        budget = self.budget - BLANK_SAMPLES * max(0, len(layers) - 1)
+
+        alloc = {}
+        spare = budget
+        for layer in layers:
+            alloc[layer] = max(0, min(len(layer.points), int(layer.share * budget), spare))
+            spare -= alloc[layer]
+
+        for layer in layers:
+            missing = len(layer.points) - alloc[layer]
+            if missing <= 0 or spare <= 0:
+                break
+            extra = min(missing, spare)
+            alloc[layer] += extra
+            spare -= extra
+
+        return alloc
+
+    def composite(self):
+        """Build one ordered output stream from all layers."""
+        with self.layer_lock:
+            layers = [layer for layer in self.layers.values() if layer.points]
+
+        # Highest priority first - it gets budget first and anchors the order
+        layers.sort(key=lambda layer: layer.priority, reverse=True)
+        alloc = self.allocate(layers)
+
+        # Greedy ordering: after each layer, jump to whichever remaining layer
+        # starts (or, reversed, ends) nearest the beam, so blank moves stay short
+        pending = [decimate(layer.points, alloc[layer]) for layer in layers]
+        pending = [points for points in pending if points]
+        output = []
+        while pending:
+            if not output:
+                points = pending.pop(0)
+            else:
+                beam = output[-1]
+                best = min(range(len(pending)),
+                           key=lambda i: min(distance_sq(beam, pending[i][0]),
+                                             distance_sq(beam, pending[i][-1])))
+                points = pending.pop(best)
+                if distance_sq(beam, points[-1]) < distance_sq(beam, points[0]):
+                    points = points[::-1]
+                output.extend(line_to_points(beam[0], beam[1], points[0][0], points[0][1], BLANK_SAMPLES))
+            output.extend(points)
+
+        self.last_allocation = {layer.name: (alloc[layer], len(layer.points)) for layer in layers}
+        return output
+
+    def compose_loop(self):
+        """Background thread to recomposite when layers change."""
+        while self.running:
+            if not self.dirty.wait(0.5):
+                continue
+            self.dirty.clear()
+
+            try:
+                points = self.composite()
+            except Exception as e:
+                # Keep the last good stream rather than stopping all compositing
+                print(f"Composite error: {e}")
+                continue
+
+            with self.audio_lock:
+                self.audio_points = points
+            self.compose_count += 1
+
+            # Coalesce bursts of updates (e.g. a client spamming display lists)
+            time.sleep(COMPOSE_INTERVAL)
+
+    def audio_callback(self, outdata, frames, time_info, status):
+        """Called by sounddevice to fill audio buffer."""
+        if status:
+            print(f"Audio status: {status}")
+            if status.output_underflow:
+                self.underruns += 1
+
+        with self.audio_lock:
+            points = self.audio_points
+
+        if not points:
+            outdata.fill(0)
+            return
+
+        for i in range(frames):
+            idx = (self.audio_index + i) % len(points)
+            x, y = points[idx]
+            outdata[i, 0] = x * AMPLITUDE  # Left = X
+            outdata[i, 1] = y * AMPLITUDE  # Right = Y
+
+        self.audio_index = (self.audio_index + frames) % len(points)
+
+    def start_audio(self):
+        """Start audio output stream."""
+        self.stream = sd.OutputStream(
+            samplerate=SAMPLE_RATE,
+            channels=2,
+            dtype='float32',
+            callback=self.audio_callback,
+            blocksize=2048
+        )
+        self.stream.start()
+        print("[OK] Audio stream started")
+
+    def stop_audio(self):
+        """Stop audio output."""
+        if self.stream:
+            self.stream.stop()
+            self.stream.close()
+            self.stream = None
+
+    def create_socket(self):
+        """Create and bind the Unix socket."""
+        try:
+            os.unlink(self.socket_path)
+        except FileNotFoundError:
+            pass
+
+        self.socket = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.socket.bind(self.socket_path)
+        self.socket.listen(8)
+        print(f"[OK] Display socket created: {self.socket_path}")
+
+    def start(self):
+        """Start compositing and accepting clients (audio is started separately)."""
+        self.running = True
+        self.create_socket()
+        threading.Thread(target=self.compose_loop, daemon=True).start()
+        threading.Thread(target=self.accept_loop, daemon=True).start()
+
+    def accept_loop(self):
+        """Background thread to accept display clients."""
+        while self.running:
+            try:
+                client, _ = self.socket.accept()
+            except OSError:
+                break  # Socket closed on shutdown
+
+            self.clients.append(client)
+            threading.Thread(target=self.client_loop, args=(client,), daemon=True).start()
+
+    def client_loop(self, client):
+        """Per-client thread: read display lists until the client goes away."""
+        layer_id = id(client)
+        name = f"client-{layer_id:x}"
+        send_message(client, MSG_INIT_COMPLETE, {})
+
+        try:
+            while self.running:
+                header = recv_exact(client, 8)
+                if not header:
+                    break
+
+                msg_type, payload_len = struct.unpack('II', header)
+
+                # Sanity check payload length (max 1MB) - can't resync, drop client
+                if payload_len > 1048576:
+                    print(f"[{name}] Invalid payload length: {payload_len}, disconnecting")
+                    break
+
+                payload_bytes = recv_exact(client, payload_len)
+                if payload_bytes is None:
+                    break
+
+                if msg_type == MSG_SHUTDOWN:
+                    break
+                if msg_type != MSG_DISPLAY_LIST:
+                    continue
+
+                try:
+                    payload = json.loads(payload_bytes.decode('utf-8'))
+                    new_name, points, priority, share = parse_display_list(payload)
+                except (ValueError, TypeError, OverflowError):
+                    continue  # Skip bad display lists
+
+                name = new_name or name
+                self.set_layer(layer_id, points, priority=priority, share=share, name=name)
+
+        except OSError as e:
+            print(f"[{name}] Receive error: {e}")
+
+        self.remove_layer(layer_id)
+        try:
+            self.clients.remove(client)
+            client.close()
+        except (ValueError, OSError):
+            pass
+        print(f"[{name}] Disconnected")
+
+    def stop(self):
+        """Clean up resources."""
+        self.running = False
+        self.stop_audio()
+
+        for client in list(self.clients):
+            try:
+                send_message(client, MSG_SHUTDOWN, {})
+                client.close()
+            except:
+                pass
+        self.clients = []
+
+        if self.socket:
+            try:
+                self.socket.close()
+                os.unlink(self.socket_path)
+            except:
+                pass
+
+
+class DisplayClient:
+    """Submits display lists to a running DisplayServer."""
+
+    def __init__(self, name, priority=DEFAULT_PRIORITY, share=DEFAULT_SHARE,
+                 socket_path=DISPLAY_SOCKET_PATH):
+        self.name = name
+        self.priority = priority
+        self.share = share
+        self.socket_path = socket_path
+        self.socket = None
+
+    def connect(self):
+        """Connect and wait for INIT_COMPLETE. Returns True on success."""
+        self.socket = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.socket.settimeout(CONNECT_TIMEOUT)
+        try:
+            self.socket.connect(self.socket_path)
+            header = recv_exact(self.socket, 8)
+            if not header:
+                raise OSError("server closed the connection")
+            msg_type, payload_len = struct.unpack('II', header)
+            if payload_len and recv_exact(self.socket, payload_len) is None:
+                raise OSError("server closed the connection")
+        except OSError as e:
+            print(f"ERROR: Could not connect to display server: {e}")
+            print("Make sure scope_server.py or doom_scope.py is running!")
+            self._drop_socket()
+            return False
+
+        if msg_type != MSG_INIT_COMPLETE:
+            print(f"ERROR: Expected INIT_COMPLETE (0x{MSG_INIT_COMPLETE:02x}) "
+                  f"from display server, got 0x{msg_type:02x}")
+            self._drop_socket()
+            return False
+
+        self.socket.settimeout(None)
+        return True
+
+    def _drop_socket(self):
+        """Close the socket after a failed connect."""
+        try:
+            self.socket.close()
+        except OSError:
+            pass
+        self.socket = None
+
+    def submit(self, lines=None, points=None):
+        """Replace this client's display list. Returns False if the server is gone."""
+        payload = {'name': self.name, 'priority': self.priority, 'share': self.share}
+        if lines:
+            payload['lines'] = lines
+        if points:
+            payload['points'] = points
+        payload_bytes = json.dumps(payload).encode('utf-8')
+        try:
+            self.socket.sendall(struct.pack('II', MSG_DISPLAY_LIST, len(payload_bytes)) + payload_bytes)
+            return True
+        except OSError:
+            return False
+
+    def close(self):
+        """Tell the server we're leaving."""
+        if self.socket:
+            try:
+                self.socket.sendall(struct.pack('II', MSG_SHUTDOWN, 0))
+                self.socket.close()
+            except OSError:
+                pass
+            self.socket = None
+
+
+def main():
+    print("=" * 60)
+    print("ScopeDoom - Vector Display Server")
+    print("=" * 60)
+    print()
+    print("Connect your sound card to the oscilloscope:")
+    print("  Left channel  -> X input")
+    print("  Right channel -> Y input")
+    print("  Set scope to X-Y mode")
+    print()
+    print("Then run display clients, e.g.:")
+    print("  python3 scope_output.py --server")
+    print("  python3 scope_clock.py")
+    print()
+    print("=" * 60)
+
+    server = DisplayServer()
+    try:
+        server.start_audio()
+        server.start()
+
+        print("\n[OK] Running! Press Ctrl+C to stop\n")
+
+        while True:
+            time.sleep(1.0)
+            with server.audio_lock:
+                total = len(server.audio_points)
+            if total:
+                layers = " | ".join(f"{name}: {used}/{wanted}"
+                                    for name, (used, wanted) in server.last_allocation.items())
+                print(f"Refresh: {SAMPLE_RATE / total:.1f} Hz | Samples: {total} | {layers}")
+
+    except KeyboardInterrupt:
+        print("\n\nStopping...")
+    finally:
+        server.stop()
+
+    print("[OK] Cleanup complete")
+
+
+if __name__ == '__main__':
+    main()